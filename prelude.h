@@ -1,10 +1,30 @@
 #pragma once
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <forward_list>
 #include <functional>
+#include <initializer_list>
 #include <iterator>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <new>
 #include <numeric>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <type_traits>
+#include <unordered_map>
+#include <utility>
+#include <vector>
 
 namespace Prelude {
 
@@ -17,10 +37,193 @@ namespace Prelude {
 #define Number typename
 #define Ordinal typename
 
+namespace detail {
+
+// Most functions below pick an implementation by the container's iterator
+// category.
+template <typename _Container>
+using CategoryOf = typename std::iterator_traits<
+    typename _Container::const_iterator>::iterator_category;
+
+template <typename _Container>
+auto category(const _Container&) -> CategoryOf<_Container> {
+  return CategoryOf<_Container>{};
+}
+
+// std::forward_list doesn't know its size.
+template <typename _Container>
+auto size(const _Container& c, int) -> decltype(std::size_t{c.size()}) {
+  return c.size();
+}
+
+template <typename _Container>
+auto size(const _Container& c, long) -> std::size_t {
+  return std::distance(std::begin(c), std::end(c));
+}
+
+template <typename _Container>
+auto reserve(_Container& c, std::size_t n, int)
+    -> decltype(c.reserve(n), void()) {
+  c.reserve(n);
+}
+
+template <typename _Container>
+auto reserve(_Container&, std::size_t, long) -> void {}
+
+template <typename _Container>
+auto shrinkToFit(_Container& c, int) -> decltype(c.shrink_to_fit(), void()) {
+  c.shrink_to_fit();
+}
+
+template <typename _Container>
+auto shrinkToFit(_Container&, long) -> void {}
+
+// first advanced by n, but not past last.
+template <typename It>
+auto advanceAtMost(It first, It last, std::size_t n,
+                   std::random_access_iterator_tag) -> It {
+  return static_cast<std::size_t>(last - first) < n ? last : first + n;
+}
+
+template <typename It>
+auto advanceAtMost(It first, It last, std::size_t n, std::forward_iterator_tag)
+    -> It {
+  for (; n && first != last; --n) {
+    ++first;
+  }
+  return first;
+}
+
+template <typename _Container>
+auto lastElement(const _Container& c, std::bidirectional_iterator_tag)
+    -> decltype(std::begin(c)) {
+  return std::prev(std::end(c));
+}
+
+template <typename _Container>
+auto lastElement(const _Container& c, std::forward_iterator_tag)
+    -> decltype(std::begin(c)) {
+  auto res = std::begin(c);
+  for (auto it = res; it != std::end(c); ++it) {
+    res = it;
+  }
+  return res;
+}
+
+template <Type A, typename AllocA>
+auto beforeEnd(std::forward_list<A, AllocA>& c) ->
+    typename std::forward_list<A, AllocA>::iterator {
+  auto res = c.before_begin();
+  for (auto it = std::begin(c); it != std::end(c); ++it) {
+    res = it;
+  }
+  return res;
+}
+
+template <typename _Container, typename It>
+auto append(_Container& c, It first, It last) -> void {
+  c.insert(std::end(c), first, last);
+}
+
+// Joining temporaries reuses the left one, lists are spliced in O(1).
+template <Type A, typename AllocA>
+auto joinInto(std::list<A, AllocA>& left, std::list<A, AllocA>& right)
+    -> void {
+  left.splice(std::end(left), right);
+}
+
+template <Type A, typename AllocA>
+auto joinInto(std::forward_list<A, AllocA>& left,
+              std::forward_list<A, AllocA>& right) -> void {
+  left.splice_after(beforeEnd(left), right);
+}
+
+// Output iterator appending to c, std::forward_list has no push_back.
+template <typename A, typename AllocA>
+class InsertAfterIterator {
+ public:
+  using iterator_category = std::output_iterator_tag;
+  using value_type = void;
+  using difference_type = void;
+  using pointer = void;
+  using reference = void;
+
+  explicit InsertAfterIterator(std::forward_list<A, AllocA>& c)
+      : c_(&c), pos_(beforeEnd(c)) {}
+
+  auto operator=(const A& x) -> InsertAfterIterator& {
+    pos_ = c_->insert_after(pos_, x);
+    return *this;
+  }
+
+  auto operator=(A&& x) -> InsertAfterIterator& {
+    pos_ = c_->insert_after(pos_, std::move(x));
+    return *this;
+  }
+
+  auto operator*() -> InsertAfterIterator& { return *this; }
+  auto operator++() -> InsertAfterIterator& { return *this; }
+  auto operator++(int) -> InsertAfterIterator& { return *this; }
+
+ private:
+  std::forward_list<A, AllocA>* c_;
+  typename std::forward_list<A, AllocA>::iterator pos_;
+};
+
+template <typename _Container>
+auto inserter(_Container& c) -> std::back_insert_iterator<_Container> {
+  return std::back_inserter(c);
+}
+
+template <typename A, typename AllocA>
+auto inserter(std::forward_list<A, AllocA>& c)
+    -> InsertAfterIterator<A, AllocA> {
+  return InsertAfterIterator<A, AllocA>{c};
+}
+
+template <typename _Container>
+auto joinInto(_Container& left, _Container& right) -> void {
+  reserve(left, size(left, 0) + size(right, 0), 0);
+  append(left, std::make_move_iterator(std::begin(right)),
+         std::make_move_iterator(std::end(right)));
+}
+
+template <typename _Container>
+auto at(const _Container& c, std::size_t pos, std::random_access_iterator_tag)
+    -> typename _Container::const_reference {
+  return c.at(pos);
+}
+
+template <typename _Container>
+auto at(const _Container& c, std::size_t pos, std::forward_iterator_tag)
+    -> typename _Container::const_reference {
+  auto it = advanceAtMost(std::begin(c), std::end(c), pos,
+                          std::forward_iterator_tag{});
+  if (it == std::end(c)) {
+    throw std::out_of_range{"Position has to be within size of Container."};
+  }
+  return *it;
+}
+
+template <typename _Container>
+auto reverse(const _Container& c, std::bidirectional_iterator_tag)
+    -> _Container {
+  return _Container(c.rbegin(), c.rend());
+}
+
+template <typename _Container>
+auto reverse(const _Container& c, std::forward_iterator_tag) -> _Container {
+  auto res = _Container{c};
+  res.reverse();
+  return res;
+}
+
+}  // namespace detail
+
 // not :: (a -> Bool) -> (a -> Bool)
 template <Type A>  // needs to be passed explicitly for the moment
 auto not_(const std::function<bool(A)>& p) -> std::function<bool(A)> {
-  return [&](A x) { return !p(x); };
+  return [p](A x) { return !p(x); };
 }
 
 // -----------------
@@ -34,7 +237,7 @@ template <Function FN, Container CN, Type A,
           typename AllocB = std::allocator<B>>
 auto map(const FN& f, const CN<A, AllocA>& c) -> CN<B, AllocB> {
   auto res = CN<B, AllocB>{};
-  std::transform(std::begin(c), std::end(c), std::back_inserter(res), f);
+  std::transform(std::begin(c), std::end(c), detail::inserter(res), f);
   return res;
 }
 
@@ -42,50 +245,57 @@ auto map(const FN& f, const CN<A, AllocA>& c) -> CN<B, AllocB> {
 template <Container CN, Type A, typename AllocA = std::allocator<A>>
 auto join(const CN<A, AllocA>& left, const CN<A, AllocA>& right)
     -> CN<A, AllocA> {
-  auto res = CN<A, AllocA>{left};
-  res.insert(std::end(res), std::begin(right), std::end(right));
+  auto res = CN<A, AllocA>{};
+  detail::reserve(res, detail::size(left, 0) + detail::size(right, 0), 0);
+  auto out = std::copy(std::begin(left), std::end(left), detail::inserter(res));
+  std::copy(std::begin(right), std::end(right), out);
   return res;
 }
 
+template <Container CN, Type A, typename AllocA = std::allocator<A>>
+auto join(CN<A, AllocA>&& left, CN<A, AllocA>&& right) -> CN<A, AllocA> {
+  detail::joinInto(left, right);
+  return std::move(left);
+}
+
 // filter :: (a -> Bool) -> [a] -> [a]
 template <Predicate PR, Container CN, Type A,
           typename AllocA = std::allocator<A>>
 auto filter(const PR& p, const CN<A, AllocA>& c) -> CN<A, AllocA> {
   auto res = CN<A, AllocA>{};
-  res.reserve(c.size());
-  std::copy_if(std::begin(c), std::end(c), std::back_inserter(res), p);
-  res.shrink_to_fit();
+  detail::reserve(res, detail::size(c, 0), 0);
+  std::copy_if(std::begin(c), std::end(c), detail::inserter(res), p);
+  detail::shrinkToFit(res, 0);
   return res;
 }
 
 // head :: [a] -> a
 template <Container CN, Type A, typename AllocA = std::allocator<A>>
 auto head(const CN<A, AllocA>& c) -> A {
-  assert(c.size() && "Container can't be empty.");
+  assert(!c.empty() && "Container can't be empty.");
   return c.front();
 }
 
 // last :: [a] -> a
 template <Container CN, Type A, typename AllocA = std::allocator<A>>
 auto last(const CN<A, AllocA>& c) -> A {
-  assert(c.size() && "Container can't be empty.");
-  return c.back();
+  assert(!c.empty() && "Container can't be empty.");
+  return *detail::lastElement(c, detail::category(c));
 }
 
 // tail :: [a] -> [a]
 template <Container CN, Type A, typename AllocA = std::allocator<A>>
 auto tail(const CN<A, AllocA>& c) -> CN<A, AllocA> {
-  assert(c.size() && "Container can't be empty.");
-  auto res = CN<A, AllocA>{std::begin(c) + 1, std::end(c)};
-  return res;
+  assert(!c.empty() && "Container can't be empty.");
+  return CN<A, AllocA>(std::next(std::begin(c)), std::end(c));
 }
 
 // init :: [a] -> [a]
 template <Container CN, Type A, typename AllocA = std::allocator<A>>
 auto init(const CN<A, AllocA>& c) -> CN<A, AllocA> {
-  assert(c.size() && "Container can't be empty.");
-  auto res = CN<A, AllocA>{std::begin(c), std::end(c) - 1};
-  return res;
+  assert(!c.empty() && "Container can't be empty.");
+  return CN<A, AllocA>(std::begin(c),
+                       detail::lastElement(c, detail::category(c)));
 }
 
 // null :: [a] -> Bool
@@ -97,22 +307,19 @@ auto null(const _Container& c) -> bool {
 // length :: [a] -> Int
 template <typename _Container>
 auto length(const _Container& c) -> std::size_t {
-  return c.size();
+  return detail::size(c, 0);
 }
 
 // (!!) :: [a] -> Int -> a
 template <Container CN, Type A, typename AllocA = std::allocator<A>>
 auto at(const CN<A, AllocA>& c, std::size_t pos) -> A {
-  assert(pos < c.size() && "Position has to be within size of Container.");
-  return c.at(pos);
+  return detail::at(c, pos, detail::category(c));
 }
 
 // reverse :: [a] -> [a]
 template <Container CN, Type A, typename AllocA = std::allocator<A>>
 auto reverse(const CN<A, AllocA>& c) -> CN<A, AllocA> {
-  auto res = CN<A, AllocA>{c};
-  std::reverse(std::begin(res), std::end(res));
-  return res;
+  return detail::reverse(c, detail::category(c));
 }
 
 // ------------------------
@@ -130,8 +337,8 @@ auto foldl(const FN& f, B&& acc, const CN<A, AllocA>& c) -> B {
 template <Function FN, Container CN, Type A,
           typename AllocA = std::allocator<A>>
 auto foldl1(const FN& f, const CN<A, AllocA>& c) -> A {
-  assert(c.size() && "Container can't be empty.");
-  return std::accumulate(std::begin(c) + 1, std::end(c), c.front(), f);
+  assert(!c.empty() && "Container can't be empty.");
+  return std::accumulate(std::next(std::begin(c)), std::end(c), c.front(), f);
 }
 
 // foldr :: (a -> b -> b) -> b -> [a] -> b
@@ -152,13 +359,193 @@ auto foldr(const FN& f, B&& acc, const CN<A, AllocA>& c) -> B {
 template <Function FN, Container CN, Type A,
           typename AllocA = std::allocator<A>>
 auto foldr1(const FN& f, const CN<A, AllocA>& c) -> A {
-  assert(c.size() && "Container can't be empty.");
+  assert(!c.empty() && "Container can't be empty.");
   if (null(tail(c))) {
     return head(c);
   }
   return f(head(c), foldr1<FN, CN, A, AllocA>(f, tail(c)));
 }
 
+// ------------------------
+//  Short-circuiting folds
+// ------------------------
+
+// data Maybe a = Nothing | Just a
+template <Type A>
+class Maybe {
+ public:
+  Maybe() : just_(false) {}
+  Maybe(const A& x) : just_(true) { new (&value_) A(x); }
+  Maybe(A&& x) : just_(true) { new (&value_) A(std::move(x)); }
+  Maybe(const Maybe& other) : just_(other.just_) {
+    if (just_) {
+      new (&value_) A(other.value_);
+    }
+  }
+  Maybe(Maybe&& other) : just_(other.just_) {
+    if (just_) {
+      new (&value_) A(std::move(other.value_));
+    }
+  }
+  ~Maybe() { reset(); }
+
+  auto operator=(Maybe other) -> Maybe& {
+    reset();
+    if (other.just_) {
+      new (&value_) A(std::move(other.value_));
+      just_ = true;
+    }
+    return *this;
+  }
+
+  explicit operator bool() const { return just_; }
+
+  auto operator*() const -> const A& {
+    assert(just_ && "Maybe can't be Nothing.");
+    return value_;
+  }
+  auto operator*() -> A& {
+    assert(just_ && "Maybe can't be Nothing.");
+    return value_;
+  }
+
+  auto operator==(const Maybe& other) const -> bool {
+    return just_ == other.just_ && (!just_ || value_ == other.value_);
+  }
+  auto operator!=(const Maybe& other) const -> bool {
+    return !(*this == other);
+  }
+
+ private:
+  auto reset() -> void {
+    if (just_) {
+      value_.~A();
+      just_ = false;
+    }
+  }
+
+  bool just_;
+  union {
+    A value_;
+  };
+};
+
+template <Type A>
+auto just(A x) -> Maybe<A> {
+  return Maybe<A>{std::move(x)};
+}
+
+template <Type A>
+auto nothing() -> Maybe<A> {
+  return Maybe<A>{};
+}
+
+// foldlWhile :: (b -> Bool) -> (b -> a -> b) -> b -> [a] -> b
+// Like foldl but stops as soon as the accumulator fails p.
+template <Predicate PR, Function FN, Type B, typename _Container>
+auto foldlWhile(const PR& p, const FN& f, B acc, const _Container& c) -> B {
+  for (auto it = std::begin(c); it != std::end(c) && p(acc); ++it) {
+    acc = f(std::move(acc), *it);
+  }
+  return acc;
+}
+
+// foldlUntil :: (b -> Bool) -> (b -> a -> b) -> b -> [a] -> b
+// Like foldl but stops as soon as the accumulator satisfies p.
+template <Predicate PR, Function FN, Type B, typename _Container>
+auto foldlUntil(const PR& p, const FN& f, B acc, const _Container& c) -> B {
+  for (auto it = std::begin(c); it != std::end(c) && !p(acc); ++it) {
+    acc = f(std::move(acc), *it);
+  }
+  return acc;
+}
+
+namespace detail {
+
+template <Function FN, typename M, typename It>
+auto foldM(const FN& f, M res, It first, It last) -> M {
+  for (; first != last && res; ++first) {
+    res = f(std::move(*res), *first);
+  }
+  return res;
+}
+
+}  // namespace detail
+
+// foldM :: (b -> a -> m b) -> b -> [a] -> m b
+// m is any Maybe-like type: constructible from b, false when terminal and
+// dereferencing to b otherwise (Maybe, std::optional, std::expected, ...).
+// Stops at the first terminal result and returns it.
+template <Function FN, Type B, typename _Container,
+          typename M = typename std::result_of<
+              FN(B, typename _Container::value_type)>::type>
+auto foldM(const FN& f, B acc, const _Container& c) -> M {
+  return detail::foldM(f, M{std::move(acc)}, std::begin(c), std::end(c));
+}
+
+// parFoldM :: (b -> a -> m b) -> (b -> b -> m b) -> b -> [a] -> m b
+// Parallel foldM over nthreads chunks. Each chunk is folded from acc, which
+// has to be the identity of g, and the chunk results are combined in order
+// with g, which appends a chunk's result to the prefix before it. g has to
+// terminate wherever foldM would terminate inside that chunk, e.g. a
+// saturated sum checks the bound in both f and g. Any chunk that terminates,
+// or whose combination does, is folded again from the actual prefix, so the
+// result is the same as that of foldM. Once a chunk terminates, the chunks
+// after it are cancelled.
+template <Function FN, Function GN, Type B, typename _Container,
+          typename M = typename std::result_of<
+              FN(B, typename _Container::value_type)>::type>
+auto parFoldM(const FN& f, const GN& g, const B& acc, const _Container& c,
+              std::size_t nthreads = std::thread::hardware_concurrency())
+    -> M {
+  auto n = detail::size(c, 0);
+  nthreads = std::max<std::size_t>(1, std::min<std::size_t>(nthreads, n));
+  std::atomic<std::size_t> firstTerminated{nthreads};
+  auto results = std::vector<M>(nthreads, M{acc});
+  auto complete = std::vector<char>(nthreads, false);
+  auto bounds = std::vector<decltype(std::begin(c))>{std::begin(c)};
+  auto workers = std::vector<std::thread>{};
+  for (std::size_t t = 0; t < nthreads; ++t) {
+    auto first = bounds.back();
+    auto last = std::next(first, n / nthreads + (t < n % nthreads));
+    bounds.push_back(last);
+    workers.emplace_back([&, t, first, last] {
+      auto& res = results[t];
+      for (auto it = first; it != last; ++it) {
+        if (firstTerminated.load(std::memory_order_relaxed) < t) {
+          return;
+        }
+        res = f(std::move(*res), *it);
+        if (!res) {
+          auto seen = firstTerminated.load();
+          while (t < seen && !firstTerminated.compare_exchange_weak(seen, t)) {
+          }
+          return;
+        }
+      }
+      complete[t] = true;
+    });
+  }
+  for (auto& w : workers) {
+    w.join();
+  }
+  auto prefix = M{acc};
+  for (std::size_t t = 0; t < nthreads; ++t) {
+    if (complete[t]) {
+      auto next = g(*prefix, std::move(*results[t]));
+      if (next) {
+        prefix = std::move(next);
+        continue;
+      }
+    }
+    prefix = detail::foldM(f, std::move(prefix), bounds[t], bounds[t + 1]);
+    if (!prefix) {
+      break;
+    }
+  }
+  return prefix;
+}
+
 // ---------------
 //  Special folds
 // ---------------
@@ -201,12 +588,199 @@ auto product(const CN<A, AllocA>& c) -> A {
   return foldl([](const A& acc, const A& x) { return acc * x; }, A{1}, c);
 }
 
+// Floating point sums. sum adds left to right, which loses precision on long
+// inputs and pins the order of operations. The variants below split the
+// input into fixed blocks, each added up in SumLanes interleaved lanes that
+// the compiler can map onto vector registers. The lane count and block size
+// are constants, so the order of operations never depends on the hardware.
+
+namespace detail {
+
+constexpr std::size_t SumLanes = 8;
+constexpr std::size_t SumBlock = 4096;
+
+// Exact rounding error of t = a + b (Knuth's TwoSum). Unlike Neumaier's
+// variant it doesn't compare magnitudes, so the lane loops below vectorize.
+// Once t is no longer finite the error is inf - inf, i.e. NaN.
+template <Number A>
+auto sumError(A a, A b, A t) -> A {
+  auto bp = t - a;
+  return (a - (t - bp)) + (b - bp);
+}
+
+// Kahan summation, the running error goes into comp. Errors of sums that
+// aren't finite are dropped rather than turning comp into NaN.
+template <Number A>
+auto compensatedAdd(A& acc, A& comp, A x) -> void {
+  auto t = acc + x;
+  auto err = sumError(acc, x, t);
+  comp += std::isfinite(t) ? err : A{0};
+  acc = t;
+}
+
+// Sum of a compensated accumulator. Infinities and NaN are absorbing, so acc
+// is finite iff every partial sum was, otherwise comp is meaningless.
+template <Number A>
+auto compensatedValue(A acc, A comp) -> A {
+  return std::isfinite(acc) ? acc + comp : acc;
+}
+
+template <Number A>
+struct Compensated {
+  A acc;
+  A comp;
+};
+
+template <Number A>
+auto combine(Compensated<A> left, const Compensated<A>& right)
+    -> Compensated<A> {
+  compensatedAdd(left.acc, left.comp, right.acc);
+  left.comp += right.comp;
+  return left;
+}
+
+// Plain sum of n elements in SumLanes lanes, lanes are combined pairwise.
+template <Number A, typename It>
+auto laneSum(It first, std::size_t n) -> A {
+  A acc[SumLanes] = {};
+  std::size_t i = 0;
+  for (; i + SumLanes <= n; i += SumLanes) {
+    for (std::size_t l = 0; l < SumLanes; ++l, ++first) {
+      acc[l] += *first;
+    }
+  }
+  for (std::size_t l = 0; i < n; ++i, ++l, ++first) {
+    acc[l] += *first;
+  }
+  for (std::size_t width = 1; width < SumLanes; width *= 2) {
+    for (std::size_t l = 0; l < SumLanes; l += 2 * width) {
+      acc[l] += acc[l + width];
+    }
+  }
+  return acc[0];
+}
+
+// Compensated sum of n elements in SumLanes lanes. The finiteness check of
+// compensatedAdd would keep the main loop scalar, a lane that overflows
+// leaves comp NaN instead and compensatedValue ignores it.
+template <Number A, typename It>
+auto compensatedLaneSum(It first, std::size_t n) -> Compensated<A> {
+  A acc[SumLanes] = {};
+  A comp[SumLanes] = {};
+  auto add = [&](std::size_t l, A x) {
+    auto t = acc[l] + x;
+    comp[l] += sumError(acc[l], x, t);
+    acc[l] = t;
+  };
+  std::size_t i = 0;
+  for (; i + SumLanes <= n; i += SumLanes) {
+    for (std::size_t l = 0; l < SumLanes; ++l, ++first) {
+      add(l, static_cast<A>(*first));
+    }
+  }
+  for (std::size_t l = 0; i < n; ++i, ++l, ++first) {
+    add(l, static_cast<A>(*first));
+  }
+  for (std::size_t width = 1; width < SumLanes; width *= 2) {
+    for (std::size_t l = 0; l < SumLanes; l += 2 * width) {
+      compensatedAdd(acc[l], comp[l], acc[l + width]);
+      comp[l] += comp[l + width];
+    }
+  }
+  return Compensated<A>{acc[0], comp[0]};
+}
+
+template <Number A, typename It>
+auto pairwiseSum(It first, std::size_t n) -> A {
+  if (n <= SumBlock) {
+    return laneSum<A>(first, n);
+  }
+  auto half = (n / 2 + SumBlock - 1) / SumBlock * SumBlock;
+  auto left = pairwiseSum<A>(first, half);
+  return left + pairwiseSum<A>(std::next(first, half), n - half);
+}
+
+// Block results are always combined in the same balanced tree.
+template <Number A>
+auto combineBlocks(const std::vector<Compensated<A>>& blocks, std::size_t lo,
+                   std::size_t hi) -> Compensated<A> {
+  if (hi - lo == 1) {
+    return blocks[lo];
+  }
+  auto mid = lo + (hi - lo) / 2;
+  return combine(combineBlocks(blocks, lo, mid),
+                 combineBlocks(blocks, mid, hi));
+}
+
+}  // namespace detail
+
+// sumPairwise :: Floating a => [a] -> a
+// Pairwise summation, the error grows with log n instead of n.
+template <typename _Container, Number A = typename _Container::value_type>
+auto sumPairwise(const _Container& c) -> A {
+  static_assert(std::is_floating_point<A>::value, "Needs floating point.");
+  return detail::pairwiseSum<A>(std::begin(c), detail::size(c, 0));
+}
+
+// parSum :: Floating a => [a] -> a
+// Compensated (Kahan-Neumaier) sum on nthreads threads. Blocks and the order
+// in which they are combined don't depend on nthreads, so the result is bit
+// identical for any number of threads.
+template <typename _Container, Number A = typename _Container::value_type>
+auto parSum(const _Container& c,
+            std::size_t nthreads = std::thread::hardware_concurrency()) -> A {
+  static_assert(std::is_floating_point<A>::value, "Needs floating point.");
+  auto n = detail::size(c, 0);
+  if (n == 0) {
+    return A{0};
+  }
+  auto nblocks = (n + detail::SumBlock - 1) / detail::SumBlock;
+  nthreads = std::max<std::size_t>(1, std::min<std::size_t>(nthreads, nblocks));
+  auto blocks = std::vector<detail::Compensated<A>>(nblocks);
+  auto work = [&](decltype(std::begin(c)) first, std::size_t b0,
+                  std::size_t b1) {
+    for (auto b = b0; b < b1; ++b) {
+      auto len = std::min(detail::SumBlock, n - b * detail::SumBlock);
+      blocks[b] = detail::compensatedLaneSum<A>(first, len);
+      if (b + 1 < b1) {
+        std::advance(first, len);
+      }
+    }
+  };
+  auto workers = std::vector<std::thread>{};
+  auto first = std::begin(c);
+  auto b0 = std::size_t{0};
+  for (std::size_t t = 0; t < nthreads; ++t) {
+    auto b1 = b0 + nblocks / nthreads + (t < nblocks % nthreads);
+    if (t + 1 == nthreads) {
+      work(first, b0, b1);
+    } else {
+      workers.emplace_back(work, first, b0, b1);
+      std::advance(first, (b1 - b0) * detail::SumBlock);
+    }
+    b0 = b1;
+  }
+  for (auto& w : workers) {
+    w.join();
+  }
+  auto res = detail::combineBlocks(blocks, 0, nblocks);
+  return detail::compensatedValue(res.acc, res.comp);
+}
+
+// sumKahan :: Floating a => [a] -> a
+// Compensated sum on the calling thread, same result as parSum.
+template <typename _Container, Number A = typename _Container::value_type>
+auto sumKahan(const _Container& c) -> A {
+  return parSum(c, 1);
+}
+
 // concat :: [[a]] -> [a]
 template <typename _Container, typename Inner = typename _Container::value_type>
 auto concat(const _Container& c) -> Inner {
   auto res = Inner{};
-  for (const auto _c : c) {
-    res.insert(std::end(res), std::begin(_c), std::end(_c));
+  auto out = detail::inserter(res);
+  for (const auto& _c : c) {
+    out = std::copy(std::begin(_c), std::end(_c), out);
   }
   return res;
 }
@@ -232,6 +806,623 @@ auto minimum(const _Container& c) -> A {
   return *std::min_element(std::begin(c), std::end(c));
 }
 
+// -------------------------------
+//  Incremental folds and windows
+// -------------------------------
+//
+// Stateful accumulators that are fed one element at a time instead of folding
+// a complete container. push appends an element on the right, pop drops the
+// oldest element on the left. Every update is amortized O(1).
+
+// Online foldl, value() == foldl(f, acc, everything pushed so far).
+template <Function FN, Type B>
+class RunningFold {
+ public:
+  RunningFold(const FN& f, B acc) : f_(f), acc_(std::move(acc)) {}
+
+  template <Type A>
+  auto push(const A& x) -> void {
+    acc_ = f_(std::move(acc_), x);
+  }
+
+  template <typename _Container>
+  auto pushAll(const _Container& c) -> void {
+    acc_ = foldl(f_, std::move(acc_), c);
+  }
+
+  auto value() const -> const B& { return acc_; }
+
+ private:
+  FN f_;
+  B acc_;
+};
+
+template <Function FN, Type B>
+auto runningFold(const FN& f, B acc) -> RunningFold<FN, B> {
+  return RunningFold<FN, B>{f, std::move(acc)};
+}
+
+// Sliding sum, value() == sum(window). Floating point sums are compensated
+// (see sumKahan), otherwise subtracting a large element that has left the
+// window would wipe out the small ones still in it.
+template <Number A>
+class SlidingSum {
+ public:
+  auto push(const A& x) -> void {
+    window_.push_back(x);
+    add(x, IsFloating{});
+  }
+
+  auto pop() -> void {
+    assert(!window_.empty() && "Window can't be empty.");
+    remove(window_.front(), IsFloating{});
+    window_.pop_front();
+    if (window_.empty()) {
+      acc_ = comp_ = A{0};
+    }
+  }
+
+  auto value() const -> A { return detail::compensatedValue(acc_, comp_); }
+  auto size() const -> std::size_t { return window_.size(); }
+  auto empty() const -> bool { return window_.empty(); }
+
+ private:
+  using IsFloating = std::is_floating_point<A>;
+
+  auto add(const A& x, std::true_type) -> void {
+    detail::compensatedAdd(acc_, comp_, x);
+  }
+  auto add(const A& x, std::false_type) -> void { acc_ += x; }
+  auto remove(const A& x, std::true_type) -> void {
+    detail::compensatedAdd(acc_, comp_, -x);
+  }
+  auto remove(const A& x, std::false_type) -> void { acc_ -= x; }
+
+  std::deque<A> window_;
+  A acc_{0};
+  A comp_{0};
+};
+
+// Sliding extremum over a monotonic deque. Only candidates that can still
+// become the extremum are kept, tagged with their position in the stream.
+template <Ordinal A, typename Compare>
+class SlidingExtremum {
+ public:
+  auto push(const A& x) -> void {
+    while (!candidates_.empty() && !comp_(x, candidates_.back().second)) {
+      candidates_.pop_back();
+    }
+    candidates_.emplace_back(pushed_++, x);
+  }
+
+  auto pop() -> void {
+    assert(size() && "Window can't be empty.");
+    if (candidates_.front().first == popped_) {
+      candidates_.pop_front();
+    }
+    ++popped_;
+  }
+
+  auto value() const -> const A& {
+    assert(size() && "Window can't be empty.");
+    return candidates_.front().second;
+  }
+
+  auto size() const -> std::size_t { return pushed_ - popped_; }
+  auto empty() const -> bool { return pushed_ == popped_; }
+
+ private:
+  std::deque<std::pair<std::size_t, A>> candidates_;
+  std::size_t pushed_ = 0;
+  std::size_t popped_ = 0;
+  Compare comp_;
+};
+
+// value() == maximum(window)
+template <Ordinal A>
+using SlidingMaximum = SlidingExtremum<A, std::less<A>>;
+
+// value() == minimum(window)
+template <Ordinal A>
+using SlidingMinimum = SlidingExtremum<A, std::greater<A>>;
+
+// Sliding foldl1 for any associative f using two stacks. The back stack holds
+// new elements and their running fold, the front stack holds older elements
+// (oldest on top) each with the fold from itself to the newest element in
+// the front stack. When the front runs dry, the back is flipped over.
+template <Function FN, Type A>
+class SlidingFold {
+ public:
+  explicit SlidingFold(const FN& f) : f_(f) {}
+
+  auto push(const A& x) -> void {
+    back_.emplace_back(x, back_.empty() ? x : f_(back_.back().second, x));
+  }
+
+  auto pop() -> void {
+    assert(size() && "Window can't be empty.");
+    if (front_.empty()) {
+      while (!back_.empty()) {
+        const auto& x = back_.back().first;
+        front_.emplace_back(
+            x, front_.empty() ? x : f_(x, front_.back().second));
+        back_.pop_back();
+      }
+    }
+    front_.pop_back();
+  }
+
+  auto value() const -> A {
+    assert(size() && "Window can't be empty.");
+    if (front_.empty()) {
+      return back_.back().second;
+    }
+    if (back_.empty()) {
+      return front_.back().second;
+    }
+    return f_(front_.back().second, back_.back().second);
+  }
+
+  auto size() const -> std::size_t { return front_.size() + back_.size(); }
+  auto empty() const -> bool { return front_.empty() && back_.empty(); }
+
+ private:
+  FN f_;
+  std::vector<std::pair<A, A>> front_;
+  std::vector<std::pair<A, A>> back_;
+};
+
+template <Type A, Function FN>
+auto slidingFold(const FN& f) -> SlidingFold<FN, A> {
+  return SlidingFold<FN, A>{f};
+}
+
+namespace detail {
+
+// Integers are multiplied as unsigned, at least unsigned int, so that
+// intermediate products wrap around instead of overflowing.
+template <Number A, bool = std::is_integral<A>::value>
+struct ProductType {
+  using type = A;
+};
+
+template <Number A>
+struct ProductType<A, true> {
+  using type = typename std::common_type<typename std::make_unsigned<A>::type,
+                                         unsigned>::type;
+};
+
+}  // namespace detail
+
+// Sliding product, value() == product(window). Dividing elements back out
+// goes wrong for good once any intermediate product overflowed, so the
+// window is kept in two stacks. Integral products are exact whenever the
+// product of the window fits in A.
+template <Number A>
+class SlidingProduct {
+ public:
+  auto push(const A& x) -> void { fold_.push(static_cast<P>(x)); }
+  auto pop() -> void { fold_.pop(); }
+  auto value() const -> A {
+    return fold_.empty() ? A{1} : static_cast<A>(fold_.value());
+  }
+  auto size() const -> std::size_t { return fold_.size(); }
+  auto empty() const -> bool { return fold_.empty(); }
+
+ private:
+  using P = typename detail::ProductType<A>::type;
+
+  SlidingFold<std::multiplies<P>, P> fold_{std::multiplies<P>{}};
+};
+
+// -----------
+//  Bit masks
+// -----------
+//
+// A Mask is the result of a predicate packed 64 elements to a word, as an
+// alternative to map(p, c) producing std::vector<bool>. The reductions below
+// work a word at a time and filterByMask/compress select elements without a
+// data dependent branch per element.
+
+namespace detail {
+
+inline auto popcount(std::uint64_t w) -> std::size_t {
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<std::size_t>(__builtin_popcountll(w));
+#else
+  std::size_t n = 0;
+  for (; w; w &= w - 1) {
+    ++n;
+  }
+  return n;
+#endif
+}
+
+inline auto countTrailingZeros(std::uint64_t w) -> std::size_t {
+  assert(w && "Word can't be zero.");
+#if defined(__GNUC__) || defined(__clang__)
+  return static_cast<std::size_t>(__builtin_ctzll(w));
+#else
+  std::size_t n = 0;
+  for (; !(w & 1); w >>= 1) {
+    ++n;
+  }
+  return n;
+#endif
+}
+
+}  // namespace detail
+
+class Mask {
+ public:
+  static constexpr std::size_t WordBits = 64;
+
+  Mask() = default;
+  explicit Mask(std::size_t size)
+      : size_(size), words_((size + WordBits - 1) / WordBits, 0) {}
+
+  auto operator[](std::size_t pos) const -> bool {
+    assert(pos < size_ && "Position has to be within size of Mask.");
+    return (words_[pos / WordBits] >> (pos % WordBits)) & 1;
+  }
+
+  auto set(std::size_t pos, bool value) -> void {
+    assert(pos < size_ && "Position has to be within size of Mask.");
+    auto bit = std::uint64_t{1} << (pos % WordBits);
+    auto& w = words_[pos / WordBits];
+    w = (w & ~bit) | (-static_cast<std::uint64_t>(value) & bit);
+  }
+
+  auto size() const -> std::size_t { return size_; }
+  auto empty() const -> bool { return size_ == 0; }
+
+  // Bits past size() are always zero.
+  auto words() const -> const std::vector<std::uint64_t>& { return words_; }
+  auto words() -> std::vector<std::uint64_t>& { return words_; }
+
+  auto operator==(const Mask& other) const -> bool {
+    return size_ == other.size_ && words_ == other.words_;
+  }
+  auto operator!=(const Mask& other) const -> bool { return !(*this == other); }
+
+ private:
+  std::size_t size_ = 0;
+  std::vector<std::uint64_t> words_;
+};
+
+// mask :: (a -> Bool) -> [a] -> Mask
+template <Predicate PR, typename _Container>
+auto mask(const PR& p, const _Container& c) -> Mask {
+  auto res = Mask{detail::size(c, 0)};
+  auto& words = res.words();
+  auto it = std::begin(c);
+  for (auto& w : words) {
+    auto word = std::uint64_t{0};
+    for (std::size_t j = 0; j < Mask::WordBits && it != std::end(c);
+         ++j, ++it) {
+      word |= static_cast<std::uint64_t>(static_cast<bool>(p(*it))) << j;
+    }
+    w = word;
+  }
+  return res;
+}
+
+inline auto operator&(const Mask& left, const Mask& right) -> Mask {
+  assert(left.size() == right.size() && "Masks must have the same size.");
+  auto res = left;
+  std::transform(std::begin(res.words()), std::end(res.words()),
+                 std::begin(right.words()), std::begin(res.words()),
+                 std::bit_and<std::uint64_t>{});
+  return res;
+}
+
+inline auto operator|(const Mask& left, const Mask& right) -> Mask {
+  assert(left.size() == right.size() && "Masks must have the same size.");
+  auto res = left;
+  std::transform(std::begin(res.words()), std::end(res.words()),
+                 std::begin(right.words()), std::begin(res.words()),
+                 std::bit_or<std::uint64_t>{});
+  return res;
+}
+
+inline auto operator~(const Mask& m) -> Mask {
+  auto res = m;
+  auto& words = res.words();
+  for (auto& w : words) {
+    w = ~w;
+  }
+  if (m.size() % Mask::WordBits) {
+    words.back() &= (std::uint64_t{1} << (m.size() % Mask::WordBits)) - 1;
+  }
+  return res;
+}
+
+// and :: Mask -> Bool
+inline auto and_(const Mask& m) -> bool {
+  const auto& words = m.words();
+  auto full = m.size() / Mask::WordBits;
+  for (std::size_t i = 0; i < full; ++i) {
+    if (~words[i]) {
+      return false;
+    }
+  }
+  auto rest = m.size() % Mask::WordBits;
+  return !rest || words.back() == (std::uint64_t{1} << rest) - 1;
+}
+
+// or :: Mask -> Bool
+inline auto or_(const Mask& m) -> bool {
+  const auto& words = m.words();
+  return std::any_of(std::begin(words), std::end(words),
+                     [](std::uint64_t w) { return w != 0; });
+}
+
+// Number of set bits, i.e. length (filterByMask m c).
+inline auto count(const Mask& m) -> std::size_t {
+  auto res = std::size_t{0};
+  for (auto w : m.words()) {
+    res += detail::popcount(w);
+  }
+  return res;
+}
+
+namespace detail {
+
+// Trivially copyable elements in random access storage are written
+// unconditionally and the output cursor only advances for selected elements.
+template <typename _Container>
+auto filterByMask(const Mask& m, const _Container& c, std::true_type)
+    -> _Container {
+  auto res = _Container{};
+  res.resize(c.size());
+  auto in = std::begin(c);
+  auto out = std::begin(res);
+  const auto& words = m.words();
+  for (std::size_t i = 0; i < words.size(); ++i) {
+    auto w = words[i];
+    auto left = c.size() - i * Mask::WordBits;
+    auto n = left < Mask::WordBits ? left : Mask::WordBits;
+    for (std::size_t j = 0; j < n; ++j) {
+      *out = in[j];
+      out += (w >> j) & 1;
+    }
+    in += n;
+  }
+  res.resize(out - std::begin(res));
+  shrinkToFit(res, 0);
+  return res;
+}
+
+// Otherwise only the set bits are visited.
+template <typename _Container>
+auto filterByMask(const Mask& m, const _Container& c, std::false_type)
+    -> _Container {
+  auto res = _Container{};
+  auto out = inserter(res);
+  auto base = std::begin(c);
+  auto pos = std::size_t{0};
+  const auto& words = m.words();
+  for (std::size_t i = 0; i < words.size(); ++i) {
+    for (auto w = words[i]; w; w &= w - 1) {
+      auto next = i * Mask::WordBits + countTrailingZeros(w);
+      std::advance(base, next - pos);
+      pos = next;
+      *out++ = *base;
+    }
+  }
+  return res;
+}
+
+}  // namespace detail
+
+// filterByMask :: Mask -> [a] -> [a]
+template <typename _Container>
+auto filterByMask(const Mask& m, const _Container& c) -> _Container {
+  assert(m.size() == detail::size(c, 0) &&
+         "Mask and Container must have the same size.");
+  using A = typename _Container::value_type;
+  using It = decltype(std::begin(c));
+  using Fast = std::integral_constant<
+      bool, std::is_trivially_copyable<A>::value &&
+                std::is_default_constructible<A>::value &&
+                std::is_base_of<std::random_access_iterator_tag,
+                                typename std::iterator_traits<
+                                    It>::iterator_category>::value>;
+  return detail::filterByMask(m, c, Fast{});
+}
+
+// compress :: (a -> Bool) -> [a] -> [a]
+// Same result as filter, but evaluates p into a Mask first.
+template <Predicate PR, typename _Container>
+auto compress(const PR& p, const _Container& c) -> _Container {
+  return filterByMask(mask(p, c), c);
+}
+
+// --------------
+//  Memoization
+// --------------
+//
+// memoize wraps a pure function in a bounded cache so that map, zipWith, ...
+// don't recompute it for duplicate inputs. The cache is split into shards,
+// each behind its own mutex, so that concurrent callers rarely contend. f is
+// evaluated outside of the lock.
+
+// Least recently used eviction.
+template <Type A, Type B>
+class LruCache {
+ public:
+  explicit LruCache(std::size_t capacity) : capacity_(capacity) {
+    if (!capacity) {
+      throw std::invalid_argument{"Cache capacity can't be zero."};
+    }
+  }
+
+  auto find(const A& key) -> const B* {
+    auto it = index_.find(key);
+    if (it == std::end(index_)) {
+      return nullptr;
+    }
+    entries_.splice(std::begin(entries_), entries_, it->second);
+    return &it->second->second;
+  }
+
+  auto insert(const A& key, const B& value) -> void {
+    if (index_.count(key)) {
+      return;
+    }
+    if (entries_.size() == capacity_) {
+      index_.erase(entries_.back().first);
+      entries_.pop_back();
+    }
+    entries_.emplace_front(key, value);
+    index_.emplace(key, std::begin(entries_));
+  }
+
+ private:
+  using Entries = std::list<std::pair<A, B>>;
+  std::size_t capacity_;
+  Entries entries_;
+  std::unordered_map<A, typename Entries::iterator> index_;
+};
+
+// CLOCK (second chance) eviction. Approximates LRU but a hit only sets a
+// flag instead of relinking a list node.
+template <Type A, Type B>
+class ClockCache {
+ public:
+  explicit ClockCache(std::size_t capacity) : capacity_(capacity) {
+    if (!capacity) {
+      throw std::invalid_argument{"Cache capacity can't be zero."};
+    }
+    entries_.reserve(capacity);
+  }
+
+  auto find(const A& key) -> const B* {
+    auto it = index_.find(key);
+    if (it == std::end(index_)) {
+      return nullptr;
+    }
+    auto& entry = entries_[it->second];
+    entry.referenced = true;
+    return &entry.value;
+  }
+
+  auto insert(const A& key, const B& value) -> void {
+    if (index_.count(key)) {
+      return;
+    }
+    if (entries_.size() < capacity_) {
+      index_.emplace(key, entries_.size());
+      entries_.push_back(Entry{key, value, false});
+      return;
+    }
+    while (entries_[hand_].referenced) {
+      entries_[hand_].referenced = false;
+      hand_ = (hand_ + 1) % capacity_;
+    }
+    index_.erase(entries_[hand_].key);
+    index_.emplace(key, hand_);
+    entries_[hand_] = Entry{key, value, false};
+    hand_ = (hand_ + 1) % capacity_;
+  }
+
+ private:
+  struct Entry {
+    A key;
+    B value;
+    bool referenced;
+  };
+  std::size_t capacity_;
+  std::size_t hand_ = 0;
+  std::vector<Entry> entries_;
+  std::unordered_map<A, std::size_t> index_;
+};
+
+// Copies of a Memoized share the same cache and counters.
+template <Function FN, Type A, Type B,
+          template <typename, typename> class Cache>
+class Memoized {
+ public:
+  Memoized(const FN& f, std::size_t capacity, std::size_t shards)
+      : f_(f), state_(std::make_shared<State>(capacity, shards)) {}
+
+  auto operator()(const A& x) const -> B {
+    auto& shard = state_->shardFor(x);
+    {
+      std::lock_guard<std::mutex> lock{shard.mutex};
+      if (const B* cached = shard.cache.find(x)) {
+        ++shard.hits;
+        return *cached;
+      }
+      ++shard.misses;
+    }
+    auto res = f_(x);
+    std::lock_guard<std::mutex> lock{shard.mutex};
+    shard.cache.insert(x, res);
+    return res;
+  }
+
+  auto hits() const -> std::size_t { return state_->count(&Shard::hits); }
+  auto misses() const -> std::size_t { return state_->count(&Shard::misses); }
+  auto hitRate() const -> double {
+    auto total = hits() + misses();
+    return total ? static_cast<double>(hits()) / total : 0.0;
+  }
+
+ private:
+  // Counters live in the shards, under the lock that is taken anyway, so
+  // that threads hitting different shards don't share a cache line.
+  struct Shard {
+    explicit Shard(std::size_t capacity) : cache(capacity) {}
+    std::mutex mutex;
+    Cache<A, B> cache;
+    std::size_t hits = 0;
+    std::size_t misses = 0;
+  };
+
+  struct State {
+    // The shard capacities add up to exactly capacity, so there can't be
+    // more shards than entries.
+    State(std::size_t capacity, std::size_t nshards) {
+      if (!capacity || !nshards) {
+        throw std::invalid_argument{"Capacity and shards can't be zero."};
+      }
+      nshards = std::min(nshards, capacity);
+      for (std::size_t i = 0; i < nshards; ++i) {
+        auto perShard = capacity / nshards + (i < capacity % nshards);
+        shards.emplace_back(new Shard{perShard});
+      }
+    }
+
+    auto shardFor(const A& x) -> Shard& {
+      return *shards[std::hash<A>{}(x) % shards.size()];
+    }
+
+    auto count(std::size_t Shard::*counter) -> std::size_t {
+      auto res = std::size_t{0};
+      for (auto& shard : shards) {
+        std::lock_guard<std::mutex> lock{shard->mutex};
+        res += (*shard).*counter;
+      }
+      return res;
+    }
+
+    std::vector<std::unique_ptr<Shard>> shards;
+  };
+
+  FN f_;
+  std::shared_ptr<State> state_;
+};
+
+// memoize :: (a -> b) -> (a -> b)
+template <Type A,  // needs to be passed explicitly for the moment
+          template <typename, typename> class Cache = LruCache, Function FN,
+          Type B = typename std::result_of<FN(A)>::type>
+auto memoize(const FN& f, std::size_t capacity, std::size_t shards = 16)
+    -> Memoized<FN, A, B, Cache> {
+  return Memoized<FN, A, B, Cache>{f, capacity, shards};
+}
+
 // ----------------
 //  Building lists
 // ----------------
@@ -256,15 +1447,17 @@ auto minimum(const _Container& c) -> A {
 // take :: Int -> [a] -> [a]
 template <typename _Container>
 auto take(std::size_t n, const _Container& c) -> _Container {
-  return _Container{std::begin(c),
-                    n > c.size() ? std::end(c) : std::begin(c) + n};
+  return _Container(std::begin(c), detail::advanceAtMost(std::begin(c),
+                                                        std::end(c), n,
+                                                        detail::category(c)));
 }
 
 // drop :: Int -> [a] -> [a]
 template <typename _Container>
 auto drop(std::size_t n, const _Container& c) -> _Container {
-  return _Container{n > c.size() ? std::end(c) : std::begin(c) + n,
-                    std::end(c)};
+  return _Container(detail::advanceAtMost(std::begin(c), std::end(c), n,
+                                          detail::category(c)),
+                    std::end(c));
 }
 
 // splitAt :: Int -> [a] -> ([a], [a])
@@ -315,6 +1508,151 @@ auto break_(const PR& p, const _Container& c)
 // -----------------------------
 //  Zipping and unzipping lists
 // -----------------------------
+//
+// All zips share one engine: the shortest length is computed once, the
+// output is reserved up front and a single counter drives the loop. When all
+// inputs are random access they are indexed directly, and when the output is
+// a std::vector of trivially copyable elements it is written in place, which
+// leaves the compiler a plain loop to vectorize.
+
+namespace detail {
+
+template <std::size_t... Is>
+struct Indices {};
+
+template <std::size_t N, std::size_t... Is>
+struct MakeIndices : MakeIndices<N - 1, N - 1, Is...> {};
+
+template <std::size_t... Is>
+struct MakeIndices<0, Is...> {
+  using type = Indices<Is...>;
+};
+
+// Evaluates an expanded parameter pack in order.
+inline auto swallow(std::initializer_list<int>) -> void {}
+
+inline auto minSize() -> std::size_t {
+  return std::numeric_limits<std::size_t>::max();
+}
+
+template <typename _Container, typename... Cs>
+auto minSize(const _Container& c, const Cs&... cs) -> std::size_t {
+  return std::min<std::size_t>(size(c, 0), minSize(cs...));
+}
+
+template <typename... Its>
+struct AllRandomAccess : std::true_type {};
+
+template <typename It, typename... Its>
+struct AllRandomAccess<It, Its...>
+    : std::integral_constant<
+          bool, std::is_base_of<std::random_access_iterator_tag,
+                                typename std::iterator_traits<
+                                    It>::iterator_category>::value &&
+                    AllRandomAccess<Its...>::value> {};
+
+template <typename RES>
+struct WritableInPlace : std::false_type {};
+
+template <Type A, typename AllocA>
+struct WritableInPlace<std::vector<A, AllocA>>
+    : std::integral_constant<bool,
+                             std::is_trivially_copyable<A>::value &&
+                                 std::is_default_constructible<A>::value &&
+                                 !std::is_same<A, bool>::value> {};
+
+// Random access inputs, contiguous output.
+template <typename RES, Function FN, typename... Its>
+auto zipWithLoop(RES& res, const FN& f, std::size_t n, std::true_type,
+                 std::true_type, Its... its) -> void {
+  res.resize(n);
+  auto out = res.data();
+  for (std::size_t i = 0; i < n; ++i) {
+    out[i] = f(its[i]...);
+  }
+}
+
+// Random access inputs, any output.
+template <typename RES, Function FN, typename... Its>
+auto zipWithLoop(RES& res, const FN& f, std::size_t n, std::true_type,
+                 std::false_type, Its... its) -> void {
+  auto out = inserter(res);
+  for (std::size_t i = 0; i < n; ++i) {
+    *out++ = f(its[i]...);
+  }
+}
+
+// Any inputs, any output.
+template <typename RES, Function FN, typename OUT, typename... Its>
+auto zipWithLoop(RES& res, const FN& f, std::size_t n, std::false_type, OUT,
+                 Its... its) -> void {
+  auto out = inserter(res);
+  for (std::size_t i = 0; i < n; ++i) {
+    *out++ = f(*its...);
+    swallow({(++its, 0)...});
+  }
+}
+
+template <typename RES, Function FN, typename... Cs>
+auto zipWithInto(RES& res, const FN& f, const Cs&... cs) -> void {
+  auto n = minSize(cs...);
+  reserve(res, n, 0);
+  using Indexed = AllRandomAccess<decltype(std::begin(cs))...>;
+  using InPlace = std::integral_constant<bool, Indexed::value &&
+                                                   WritableInPlace<RES>::value>;
+  zipWithLoop(res, f, n, Indexed{}, InPlace{}, std::begin(cs)...);
+}
+
+template <typename TUP>
+struct MakeTuple {
+  template <typename... As>
+  auto operator()(const As&... xs) const -> TUP {
+    return TUP{xs...};
+  }
+};
+
+template <typename _Container, typename OUT, std::size_t... Is>
+auto unzipInto(const _Container& c, OUT& outs, Indices<Is...>) -> void {
+  swallow({(reserve(std::get<Is>(outs), size(c, 0), 0), 0)...});
+  auto ins = std::make_tuple(inserter(std::get<Is>(outs))...);
+  for (const auto& t : c) {
+    swallow({(*std::get<Is>(ins)++ = std::get<Is>(t), 0)...});
+  }
+}
+
+}  // namespace detail
+
+// zipWithN :: (a -> b -> ... -> r) -> [a] -> [b] -> ... -> [r]
+template <Function FN, Container CN, Type A, typename AllocA, typename... Cs,
+          Type R = typename std::result_of<
+              FN(A, typename Cs::value_type...)>::type,
+          typename AllocR = std::allocator<R>>
+auto zipWithN(const FN& f, const CN<A, AllocA>& c, const Cs&... cs)
+    -> CN<R, AllocR> {
+  auto res = CN<R, AllocR>{};
+  detail::zipWithInto(res, f, c, cs...);
+  return res;
+}
+
+// zipN :: [a] -> [b] -> ... -> [(a, b, ...)]
+template <Container CN, Type A, typename AllocA, typename... Cs,
+          typename RES = std::tuple<A, typename Cs::value_type...>,
+          typename AllocRES = std::allocator<RES>>
+auto zipN(const CN<A, AllocA>& c, const Cs&... cs) -> CN<RES, AllocRES> {
+  auto res = CN<RES, AllocRES>{};
+  detail::zipWithInto(res, detail::MakeTuple<RES>{}, c, cs...);
+  return res;
+}
+
+// unzipN :: [(a, b, ...)] -> ([a], [b], ...)
+template <Container CN, typename AllocTUP, Type... As>
+auto unzipN(const CN<std::tuple<As...>, AllocTUP>& c)
+    -> std::tuple<CN<As, std::allocator<As>>...> {
+  auto res = std::tuple<CN<As, std::allocator<As>>...>{};
+  detail::unzipInto(c, res,
+                    typename detail::MakeIndices<sizeof...(As)>::type{});
+  return res;
+}
 
 // zip :: [a] -> [b] -> [(a, b)]
 template <Container CA, Type A, typename AllocA = std::allocator<A>,
@@ -324,13 +1662,7 @@ template <Container CA, Type A, typename AllocA = std::allocator<A>,
 auto zip(const CA<A, AllocA>& left, const CB<B, AllocB>& right)
     -> CRES<RES, AllocRES> {
   auto res = CRES<RES, AllocRES>{};
-  auto l = std::begin(left);
-  auto r = std::begin(right);
-  while (l != std::end(left) && r != std::end(right)) {
-    res.emplace_back(*l, *r);
-    ++l;
-    ++r;
-  }
+  detail::zipWithInto(res, detail::MakeTuple<RES>{}, left, right);
   return res;
 }
 
@@ -343,15 +1675,7 @@ template <Container CA, Type A, typename AllocA = std::allocator<A>,
 auto zip3(const CA<A, AllocA>& left, const CB<B, AllocB>& middle,
           const CC<C, AllocC>& right) -> CRES<RES, AllocRES> {
   auto res = CRES<RES, AllocRES>{};
-  auto l = std::begin(left);
-  auto m = std::begin(middle);
-  auto r = std::begin(right);
-  while (l != std::end(left) && m != std::end(middle) && r != std::end(right)) {
-    res.emplace_back(*l, *m, *r);
-    ++l;
-    ++m;
-    ++r;
-  }
+  detail::zipWithInto(res, detail::MakeTuple<RES>{}, left, middle, right);
   return res;
 }
 
@@ -364,13 +1688,7 @@ template <Function FN, Container CA, Type A,
 auto zipWith(const FN& f, const CA<A, AllocA>& left, const CB<B, AllocB>& right)
     -> CC<C, AllocC> {
   auto res = CC<C, AllocC>{};
-  auto l = std::begin(left);
-  auto r = std::begin(right);
-  while (l != std::end(left) && r != std::end(right)) {
-    res.emplace_back(f(*l, *r));
-    ++l;
-    ++r;
-  }
+  detail::zipWithInto(res, f, left, right);
   return res;
 }
 
@@ -385,15 +1703,7 @@ auto zipWith3(const FN& f, const CA<A, AllocA>& left,
               const CB<B, AllocB>& middle, const CC<C, AllocC>& right)
     -> CD<D, AllocD> {
   auto res = CD<D, AllocD>{};
-  auto l = std::begin(left);
-  auto m = std::begin(middle);
-  auto r = std::begin(right);
-  while (l != std::end(left) && m != std::end(middle) && r != std::end(right)) {
-    res.emplace_back(f(*l, *m, *r));
-    ++l;
-    ++m;
-    ++r;
-  }
+  detail::zipWithInto(res, f, left, middle, right);
   return res;
 }
 
@@ -405,15 +1715,9 @@ template <Container CN, typename TUP, typename AllocTUP = std::allocator<TUP>,
           typename AllocB = std::allocator<B>>
 auto unzip(const CN<TUP, AllocTUP>& c)
     -> std::tuple<CA<A, AllocA>, CB<B, AllocB>> {
-  auto ca = CA<A, AllocA>{};
-  auto cb = CB<B, AllocB>{};
-  for (const auto& t : c) {
-    // wanted to use emplace_back but not
-    // available for vector<bool>, maybe use back_inserter...
-    ca.push_back(std::get<0>(t));
-    cb.push_back(std::get<1>(t));
-  }
-  return std::make_tuple(ca, cb);
+  auto res = std::tuple<CA<A, AllocA>, CB<B, AllocB>>{};
+  detail::unzipInto(c, res, detail::MakeIndices<2>::type{});
+  return res;
 }
 
 // unzip3 :: [(a, b, c)] -> ([a], [b], [c])
@@ -426,14 +1730,158 @@ template <Container CN, typename TUP, typename AllocTUP = std::allocator<TUP>,
           typename AllocC = std::allocator<C>>
 auto unzip3(const CN<TUP, AllocTUP>& c)
     -> std::tuple<CA<A, AllocA>, CB<B, AllocB>, CC<C, AllocC>> {
-  auto ca = CA<A, AllocA>{};
-  auto cb = CB<B, AllocB>{};
-  auto cc = CC<C, AllocC>{};
-  for (const auto& t : c) {
-    ca.push_back(std::get<0>(t));
-    cb.push_back(std::get<1>(t));
-    cc.push_back(std::get<2>(t));
+  auto res = std::tuple<CA<A, AllocA>, CB<B, AllocB>, CC<C, AllocC>>{};
+  detail::unzipInto(c, res, detail::MakeIndices<3>::type{});
+  return res;
+}
+
+// ----------------------
+//  Functions on strings
+// ----------------------
+//
+// lines and words don't copy: they return StringSlices pointing into the
+// original buffer, which therefore has to outlive them. unlines and unwords
+// allocate their result exactly once.
+
+// Non-owning view of a range of chars.
+class StringSlice {
+ public:
+  using value_type = char;
+  using const_iterator = const char*;
+  using iterator = const_iterator;
+
+  StringSlice() = default;
+  StringSlice(const char* data, std::size_t size) : data_(data), size_(size) {}
+  StringSlice(const char* s) : data_(s), size_(std::strlen(s)) {}
+  StringSlice(const std::string& s) : data_(s.data()), size_(s.size()) {}
+
+  auto data() const -> const char* { return data_; }
+  auto size() const -> std::size_t { return size_; }
+  auto empty() const -> bool { return size_ == 0; }
+  auto begin() const -> const_iterator { return data_; }
+  auto end() const -> const_iterator { return data_ + size_; }
+
+  auto operator[](std::size_t pos) const -> char {
+    assert(pos < size_ && "Position has to be within size of StringSlice.");
+    return data_[pos];
+  }
+
+  auto str() const -> std::string { return std::string(data_, size_); }
+
+ private:
+  const char* data_ = nullptr;
+  std::size_t size_ = 0;
+};
+
+inline auto operator==(StringSlice left, StringSlice right) -> bool {
+  return left.size() == right.size() &&
+         std::equal(std::begin(left), std::end(left), std::begin(right));
+}
+
+inline auto operator!=(StringSlice left, StringSlice right) -> bool {
+  return !(left == right);
+}
+
+namespace detail {
+
+inline auto isSpace(char x) -> bool {
+  return x == ' ' || (x >= '\t' && x <= '\r');
+}
+
+// Finds the next space eight bytes at a time. A word without any byte below
+// 0x21 can't contain a space and is skipped without looking at its bytes.
+inline auto findSpace(const char* first, const char* last) -> const char* {
+  const auto ones = std::uint64_t{0x0101010101010101};
+  const auto highs = std::uint64_t{0x8080808080808080};
+  while (last - first >= 8) {
+    std::uint64_t w;
+    std::memcpy(&w, first, sizeof(w));
+    if ((w - ones * 0x21) & ~w & highs) {
+      break;
+    }
+    first += 8;
+  }
+  return std::find_if(first, last, isSpace);
+}
+
+}  // namespace detail
+
+// lines :: String -> [String]
+inline auto lines(StringSlice s) -> std::vector<StringSlice> {
+  auto res = std::vector<StringSlice>{};
+  auto first = s.data();
+  auto last = s.data() + s.size();
+  while (first != last) {
+    auto nl = static_cast<const char*>(std::memchr(first, '\n', last - first));
+    if (!nl) {
+      res.emplace_back(first, last - first);
+      break;
+    }
+    res.emplace_back(first, nl - first);
+    first = nl + 1;
   }
-  return std::make_tuple(ca, cb, cc);
+  return res;
+}
+
+// The slices would dangle.
+template <typename = void>
+auto lines(const std::string&& s) -> std::vector<StringSlice> = delete;
+
+// words :: String -> [String]
+inline auto words(StringSlice s) -> std::vector<StringSlice> {
+  auto res = std::vector<StringSlice>{};
+  auto first = s.data();
+  auto last = s.data() + s.size();
+  while (true) {
+    first = std::find_if_not(first, last, detail::isSpace);
+    if (first == last) {
+      break;
+    }
+    auto space = detail::findSpace(first, last);
+    res.emplace_back(first, space - first);
+    first = space;
+  }
+  return res;
+}
+
+// The slices would dangle.
+template <typename = void>
+auto words(const std::string&& s) -> std::vector<StringSlice> = delete;
+
+namespace detail {
+
+template <typename _Container>
+auto intercalate(char sep, bool trailing, const _Container& c)
+    -> std::string {
+  auto size = std::size_t{0};
+  for (const auto& x : c) {
+    size += x.size() + 1;
+  }
+  if (!trailing && size) {
+    --size;
+  }
+  auto res = std::string(size, sep);
+  auto out = std::begin(res);
+  for (const auto& x : c) {
+    out = std::copy(std::begin(x), std::end(x), out);
+    if (out != std::end(res)) {
+      ++out;
+    }
+  }
+  return res;
+}
+
+}  // namespace detail
+
+// unlines :: [String] -> String
+template <typename _Container>
+auto unlines(const _Container& c) -> std::string {
+  return detail::intercalate('\n', true, c);
+}
+
+// unwords :: [String] -> String
+template <typename _Container>
+auto unwords(const _Container& c) -> std::string {
+  return detail::intercalate(' ', false, c);
 }
 }
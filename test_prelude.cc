@@ -1,10 +1,17 @@
 #include "prelude.h"
 
 #include <array>
+#include <atomic>
 #include <cassert>
+#include <cmath>
+#include <forward_list>
 #include <iostream>
+#include <limits>
 #include <list>
+#include <numeric>
+#include <stdexcept>
 #include <string>
+#include <thread>
 #include <vector>
 
 auto test_not_() -> void {
@@ -21,6 +28,8 @@ auto test_map() -> void {
   auto even = [](int x) { return x % 2 == 0; };
   auto result = map(even, std::vector<int>{1, 2, 3, 4, 5});
   assert(result == expect);
+  auto expectF = std::forward_list<bool>{false, true, false};
+  assert(map(even, std::forward_list<int>{1, 2, 3}) == expectF);
 }
 
 auto test_join() -> void {
@@ -28,6 +37,23 @@ auto test_join() -> void {
   auto expect = std::vector<int>{1, 2, 3, 4};
   auto result = join(std::vector<int>{1, 2}, std::vector<int>{3, 4});
   assert(result == expect);
+  auto expectL = std::list<int>{1, 2, 3, 4};
+  auto left = std::list<int>{1, 2};
+  auto right = std::list<int>{3, 4};
+  assert(join(left, right) == expectL);
+  assert(join(std::move(left), std::move(right)) == expectL);
+  auto expectF = std::forward_list<int>{1, 2, 3};
+  assert(join(std::forward_list<int>{1}, std::forward_list<int>{2, 3}) ==
+         expectF);
+  auto l = std::forward_list<int>{1, 2};
+  auto r = std::forward_list<int>{3};
+  assert(join(l, r) == expectF);
+  auto empty = std::forward_list<int>{};
+  assert(join(empty, r) == r);
+  assert(join(l, empty) == l);
+  auto expectS = std::vector<std::string>{"a", "b"};
+  assert(join(std::vector<std::string>{"a"}, std::vector<std::string>{"b"}) ==
+         expectS);
 }
 
 auto test_filter() -> void {
@@ -36,6 +62,11 @@ auto test_filter() -> void {
   auto even = [](int x) { return x % 2 == 0; };
   auto result = filter(even, std::vector<int>{1, 2, 3, 4, 5});
   assert(result == expect);
+  auto expectL = std::list<int>{2, 4};
+  assert(filter(even, std::list<int>{1, 2, 3, 4, 5}) == expectL);
+  auto expectF = std::forward_list<int>{2, 4};
+  assert(filter(even, std::forward_list<int>{1, 2, 3, 4, 5}) == expectF);
+  assert(filter(even, std::forward_list<int>{1, 3}).empty());
 }
 
 auto test_head() -> void {
@@ -50,6 +81,8 @@ auto test_last() -> void {
   auto expect = 4;
   auto result = last(std::vector<int>{1, 2, 3, 4});
   assert(result == expect);
+  assert(last(std::list<int>{1, 2, 3, 4}) == expect);
+  assert(last(std::forward_list<int>{1, 2, 3, 4}) == expect);
 }
 
 auto test_tail() -> void {
@@ -57,6 +90,9 @@ auto test_tail() -> void {
   auto expect = std::vector<int>{2, 3, 4};
   auto result = tail(std::vector<int>{1, 2, 3, 4});
   assert(result == expect);
+  assert(tail(std::list<int>{1, 2, 3, 4}) == (std::list<int>{2, 3, 4}));
+  assert(tail(std::forward_list<int>{1, 2, 3, 4}) ==
+         (std::forward_list<int>{2, 3, 4}));
 }
 
 auto test_init() -> void {
@@ -64,6 +100,9 @@ auto test_init() -> void {
   auto expect = std::vector<int>{1, 2, 3};
   auto result = init(std::vector<int>{1, 2, 3, 4});
   assert(result == expect);
+  assert(init(std::list<int>{1, 2, 3, 4}) == (std::list<int>{1, 2, 3}));
+  assert(init(std::forward_list<int>{1, 2, 3, 4}) ==
+         (std::forward_list<int>{1, 2, 3}));
 }
 
 auto test_null() -> void {
@@ -76,11 +115,31 @@ auto test_length() -> void {
   using Prelude::length;
   assert(length(std::vector<int>{}) == 0);
   assert(length(std::vector<int>{1, 2, 3, 4}) == 4);
+  assert(length(std::forward_list<int>{1, 2, 3}) == 3);
 }
 
 auto test_at() -> void {
   using Prelude::at;
   assert(at(std::vector<int>{1, 2, 3, 4}, 2) == 3);
+  assert(at(std::list<int>{1, 2, 3, 4}, 2) == 3);
+  assert(at(std::forward_list<int>{1, 2, 3, 4}, 3) == 4);
+  auto thrown = 0;
+  try {
+    at(std::vector<int>{1, 2}, 5);
+  } catch (const std::out_of_range&) {
+    ++thrown;
+  }
+  try {
+    at(std::list<int>{1, 2}, 2);
+  } catch (const std::out_of_range&) {
+    ++thrown;
+  }
+  try {
+    at(std::forward_list<int>{}, 0);
+  } catch (const std::out_of_range&) {
+    ++thrown;
+  }
+  assert(thrown == 3);
 }
 
 auto test_reverse() -> void {
@@ -88,6 +147,9 @@ auto test_reverse() -> void {
   auto expect = std::vector<int>{4, 3, 2, 1};
   auto result = reverse(std::vector<int>{1, 2, 3, 4});
   assert(result == expect);
+  assert(reverse(std::list<int>{1, 2, 3, 4}) == (std::list<int>{4, 3, 2, 1}));
+  assert(reverse(std::forward_list<int>{1, 2, 3}) ==
+         (std::forward_list<int>{3, 2, 1}));
 }
 
 auto test_foldl() -> void {
@@ -104,6 +166,9 @@ auto test_foldl1() -> void {
   auto result = foldl1([](int acc, int x) { return acc + x; },
                        std::vector<int>{1, 2, 3, 4});
   assert(result == expect);
+  result = foldl1([](int acc, int x) { return acc + x; },
+                  std::forward_list<int>{1, 2, 3, 4});
+  assert(result == expect);
 }
 
 auto test_foldr() -> void {
@@ -112,6 +177,9 @@ auto test_foldr() -> void {
   auto result = foldr([](int x, int acc) { return x + acc; }, 0,
                       std::vector<int>{1, 2, 3, 4});
   assert(result == expect);
+  result = foldr([](int x, int acc) { return x + acc; }, 0,
+                 std::list<int>{1, 2, 3, 4});
+  assert(result == expect);
 }
 
 auto test_foldr1() -> void {
@@ -122,6 +190,149 @@ auto test_foldr1() -> void {
   assert(result == expect);
 }
 
+auto test_Maybe() -> void {
+  using Prelude::Maybe;
+  using Prelude::just;
+  using Prelude::nothing;
+  auto m = just(std::string{"a"});
+  assert(m && *m == "a");
+  m = nothing<std::string>();
+  assert(!m);
+  assert(m == Maybe<std::string>{});
+  m = Maybe<std::string>{"b"};
+  auto copy = m;
+  assert(copy == just(std::string{"b"}));
+}
+
+auto test_foldlWhile() -> void {
+  using Prelude::foldlWhile;
+  auto visited = 0;
+  auto add = [&visited](int acc, int x) {
+    ++visited;
+    return acc + x;
+  };
+  auto expect = 10;
+  auto result =
+      foldlWhile([](int acc) { return acc < 10; }, add, 0,
+                 std::vector<int>{1, 2, 3, 4, 5, 6, 7, 8});
+  assert(result == expect);
+  assert(visited == 4);
+}
+
+auto test_foldlUntil() -> void {
+  using Prelude::foldlUntil;
+  auto expect = 100;
+  // saturated sum
+  auto saturatedAdd = [](int acc, int x) { return std::min(100, acc + x); };
+  auto result = foldlUntil([](int acc) { return acc >= 100; }, saturatedAdd, 0,
+                           std::list<int>(1000, 7));
+  assert(result == expect);
+}
+
+auto test_foldM() -> void {
+  using Prelude::Maybe;
+  using Prelude::foldM;
+  using Prelude::just;
+  auto visited = 0;
+  auto safeAdd = [&visited](int acc, int x) -> Maybe<int> {
+    ++visited;
+    return x < 0 ? Maybe<int>{} : just(acc + x);
+  };
+  assert(foldM(safeAdd, 0, std::vector<int>{1, 2, 3, 4}) == just(10));
+  visited = 0;
+  assert(!foldM(safeAdd, 0, std::vector<int>{1, -2, 3, 4}));
+  assert(visited == 2);
+  assert(foldM(safeAdd, 5, std::vector<int>{}) == just(5));
+}
+
+auto test_parFoldM() -> void {
+  using Prelude::Maybe;
+  using Prelude::foldM;
+  using Prelude::just;
+  using Prelude::parFoldM;
+  auto safeAdd = [](long acc, int x) -> Maybe<long> {
+    return x < 0 ? Maybe<long>{} : just(acc + x);
+  };
+  auto plus = [](long x, long y) { return just(x + y); };
+  auto xs = std::vector<int>(10000, 1);
+  for (std::size_t threads : {1, 3, 8}) {
+    assert(parFoldM(safeAdd, plus, 0L, xs, threads) == just(10000L));
+  }
+  xs[42] = -1;
+  for (std::size_t threads : {1, 3, 8}) {
+    assert(!parFoldM(safeAdd, plus, 0L, xs, threads));
+  }
+  assert(parFoldM(safeAdd, plus, 0L, std::vector<int>{}, 4) == just(0L));
+  assert(parFoldM(safeAdd, plus, 0L, std::forward_list<int>{1, 2, 3}, 2) ==
+         just(6L));
+}
+
+auto test_parFoldM_accumulator() -> void {
+  using Prelude::Maybe;
+  using Prelude::foldM;
+  using Prelude::just;
+  using Prelude::parFoldM;
+  // termination depends on the accumulator, not on any single element
+  auto bound = 5000L;
+  auto boundedAdd = [&bound](long acc, long x) -> Maybe<long> {
+    return acc + x > bound ? Maybe<long>{} : just(acc + x);
+  };
+  auto xs = std::vector<long>(10000, 1);
+  for (std::size_t threads : {1, 3, 4, 8}) {
+    assert(!foldM(boundedAdd, 0L, xs));
+    assert(parFoldM(boundedAdd, boundedAdd, 0L, xs, threads) ==
+           foldM(boundedAdd, 0L, xs));
+  }
+  bound = 10000L;
+  for (std::size_t threads : {1, 3, 4, 8}) {
+    assert(parFoldM(boundedAdd, boundedAdd, 0L, xs, threads) == just(10000L));
+  }
+  // a chunk that terminates on its own but not after the actual prefix
+  auto positive = [](long acc, long x) -> Maybe<long> {
+    return acc + x < 0 ? Maybe<long>{} : just(acc + x);
+  };
+  auto ys = std::vector<long>{5, 5, -3, -3, 1, 1};
+  assert(parFoldM(positive, positive, 0L, ys, 3) == just(6L));
+}
+
+auto test_parFoldM_cancel() -> void {
+  using Prelude::Maybe;
+  using Prelude::just;
+  using Prelude::parFoldM;
+  // The first chunk terminates once the other three have started. They wait
+  // until its thread has exited, i.e. until the termination is published,
+  // so none of them may visit a second element.
+  struct OnExit {
+    std::atomic<bool>& flag;
+    ~OnExit() { flag = true; }
+  };
+  static std::atomic<bool> exited{false};
+  std::atomic<int> started{0};
+  std::atomic<int> slowVisits{0};
+  auto f = [&started, &slowVisits](long acc, int i) -> Maybe<long> {
+    if (i == 42) {
+      while (started < 3) {
+        std::this_thread::yield();
+      }
+      thread_local OnExit onExit{exited};
+      return Maybe<long>{};
+    }
+    if (i >= 1000) {
+      ++slowVisits;
+      ++started;
+      while (!exited) {
+        std::this_thread::yield();
+      }
+    }
+    return just(acc + 1);
+  };
+  auto plus = [](long x, long y) { return just(x + y); };
+  auto xs = std::vector<int>(4000);
+  std::iota(std::begin(xs), std::end(xs), 0);
+  assert(!parFoldM(f, plus, 0L, xs, 4));
+  assert(slowVisits == 3 && "Chunks after a terminated one must stop.");
+}
+
 auto test_and_() -> void {
   using Prelude::and_;
   assert(and_(std::vector<bool>{true, true, true, true}) == true);
@@ -164,12 +375,67 @@ auto test_product() -> void {
   assert(result == expect);
 }
 
+auto test_sumPairwise() -> void {
+  using Prelude::sum;
+  using Prelude::sumPairwise;
+  auto xs = std::vector<double>(1000000, 0.1);
+  auto expect = 100000.0;
+  assert(std::abs(sumPairwise(xs) - expect) < 1e-8);
+  assert(std::abs(sumPairwise(xs) - expect) < std::abs(sum(xs) - expect));
+  assert(sumPairwise(std::vector<double>{}) == 0.0);
+  assert(sumPairwise(std::forward_list<double>{0.5, 0.25}) == 0.75);
+}
+
+auto test_sumKahan() -> void {
+  using Prelude::sumKahan;
+  auto expect = 1.0;
+  auto result = sumKahan(std::vector<double>{1e16, 1.0, -1e16});
+  assert(result == expect);
+  assert(sumKahan(std::list<float>{0.5f, 0.25f}) == 0.75f);
+  auto inf = std::numeric_limits<double>::infinity();
+  auto max = std::numeric_limits<double>::max();
+  assert(sumKahan(std::vector<double>{1.0, inf}) == inf);
+  assert(sumKahan(std::vector<double>{max, max}) == inf);
+  assert(sumKahan(std::vector<double>{-max, 1.0, -max}) == -inf);
+  assert(std::isnan(sumKahan(std::vector<double>{inf, 1.0, -inf})));
+}
+
+auto test_parSum() -> void {
+  using Prelude::parSum;
+  using Prelude::sumKahan;
+  auto xs = std::vector<double>{};
+  auto x = 1.0;
+  for (auto i = 0; i < 100003; ++i) {
+    x = std::fmod(x * 7919.0 + 0.123, 1000.0);
+    xs.push_back(i % 2 ? x * 1e6 : -x * 1e-3);
+  }
+  auto expect = sumKahan(xs);
+  for (std::size_t threads : {1, 2, 3, 7, 16, 64}) {
+    assert(parSum(xs, threads) == expect);
+  }
+  assert(parSum(std::vector<double>{}, 4) == 0.0);
+  auto fs = std::forward_list<double>(xs.begin(), xs.end());
+  assert(parSum(fs, 3) == expect);
+  auto inf = std::numeric_limits<double>::infinity();
+  assert(parSum(std::vector<double>{1.0, inf}, 2) == inf);
+  auto ys = std::vector<double>(20000, 1.0);
+  ys[12345] = inf;
+  auto zs = std::vector<double>(20000, std::numeric_limits<double>::max());
+  for (std::size_t threads : {1, 2, 3, 7}) {
+    assert(parSum(ys, threads) == inf);
+    assert(parSum(zs, threads) == inf);
+  }
+}
+
 auto test_concat() -> void {
   using Prelude::concat;
   auto expect = std::vector<int>{1, 2, 3, 4, 5, 6, 7, 8, 9};
   auto result = concat(
       std::array<std::vector<int>, 3>{{{1, 2, 3}, {4, 5}, {6, 7, 8, 9}}});
   assert(result == expect);
+  auto expectF = std::forward_list<int>{1, 2, 3};
+  assert(concat(std::vector<std::forward_list<int>>{{1}, {}, {2, 3}}) ==
+         expectF);
 }
 
 auto test_concatMap() -> void {
@@ -195,6 +461,327 @@ auto test_minimum() -> void {
   assert(result == expect);
 }
 
+auto test_runningFold() -> void {
+  using Prelude::runningFold;
+  auto acc = runningFold([](int acc, int x) { return acc + x; }, 0);
+  acc.push(1);
+  acc.push(2);
+  assert(acc.value() == 3);
+  acc.pushAll(std::vector<int>{3, 4});
+  assert(acc.value() == 10);
+}
+
+auto test_SlidingSum() -> void {
+  using Prelude::SlidingSum;
+  auto window = SlidingSum<int>{};
+  assert(window.value() == 0);
+  for (auto x : {1, 2, 3, 4}) {
+    window.push(x);
+  }
+  assert(window.value() == 10);
+  window.pop();
+  window.pop();
+  assert(window.value() == 7);
+  assert(window.size() == 2);
+  auto fwindow = SlidingSum<double>{};
+  fwindow.push(1e20);
+  fwindow.push(1.0);
+  fwindow.pop();
+  assert(fwindow.value() == 1.0);
+  for (auto i = 0; i < 100000; ++i) {
+    fwindow.push(i % 2 ? 0.1 : 1e16);
+    fwindow.pop();
+  }
+  assert(std::abs(fwindow.value() - 0.1) < 1e-12);
+  auto inf = std::numeric_limits<double>::infinity();
+  auto max = std::numeric_limits<double>::max();
+  auto iwindow = SlidingSum<double>{};
+  iwindow.push(1.0);
+  iwindow.push(inf);
+  assert(iwindow.value() == inf);
+  iwindow.pop();
+  assert(iwindow.value() == inf);
+  iwindow.pop();
+  iwindow.push(max);
+  iwindow.push(max);
+  assert(iwindow.value() == inf);
+  iwindow.pop();
+  iwindow.pop();
+  iwindow.push(2.0);
+  assert(iwindow.value() == 2.0);
+}
+
+auto test_SlidingProduct() -> void {
+  using Prelude::SlidingProduct;
+  auto window = SlidingProduct<int>{};
+  for (auto x : {2, 0, 3, 4}) {
+    window.push(x);
+  }
+  assert(window.value() == 0);
+  window.pop();
+  assert(window.value() == 0);
+  window.pop();
+  assert(window.value() == 12);
+  // floating point products must recover from overflow and underflow
+  for (auto x : {10.0, 0.1}) {
+    auto fwindow = SlidingProduct<double>{};
+    for (auto i = 0; i < 400; ++i) {
+      fwindow.push(x);
+    }
+    for (auto i = 0; i < 399; ++i) {
+      fwindow.pop();
+    }
+    assert(fwindow.value() == x);
+  }
+  // so must integral ones, also while a push briefly overflows the window
+  auto iwindow = SlidingProduct<int>{};
+  iwindow.push(65536);
+  iwindow.push(65536);
+  iwindow.pop();
+  assert(iwindow.value() == 65536);
+  iwindow.push(-2);
+  iwindow.pop();
+  assert(iwindow.value() == -2);
+  auto uwindow = SlidingProduct<unsigned>{};
+  uwindow.push(2147483648u);
+  uwindow.push(2);
+  uwindow.pop();
+  uwindow.push(3);
+  assert(uwindow.value() == 6);
+  uwindow.pop();
+  uwindow.push(5);
+  assert(uwindow.value() == 15);
+  auto swindow = SlidingProduct<short>{};
+  swindow.push(300);
+  swindow.push(300);
+  swindow.pop();
+  assert(swindow.value() == 300);
+}
+
+auto test_SlidingMaximum() -> void {
+  using Prelude::SlidingMaximum;
+  using Prelude::SlidingMinimum;
+  auto xs = std::vector<int>{3, 1, 4, 1, 5, 9, 2, 6, 5, 3};
+  auto expectMax = std::vector<int>{4, 4, 5, 9, 9, 9, 6, 6};
+  auto expectMin = std::vector<int>{1, 1, 1, 1, 2, 2, 2, 3};
+  auto wmax = SlidingMaximum<int>{};
+  auto wmin = SlidingMinimum<int>{};
+  auto resultMax = std::vector<int>{};
+  auto resultMin = std::vector<int>{};
+  for (auto x : xs) {
+    wmax.push(x);
+    wmin.push(x);
+    if (wmax.size() > 3) {
+      wmax.pop();
+      wmin.pop();
+    }
+    if (wmax.size() == 3) {
+      resultMax.push_back(wmax.value());
+      resultMin.push_back(wmin.value());
+    }
+  }
+  assert(resultMax == expectMax);
+  assert(resultMin == expectMin);
+}
+
+auto test_slidingFold() -> void {
+  using Prelude::slidingFold;
+  // string concatenation is associative but not commutative
+  auto window = slidingFold<std::string>(
+      [](const std::string& a, const std::string& b) { return a + b; });
+  window.push("a");
+  window.push("b");
+  window.push("c");
+  assert(window.value() == "abc");
+  window.pop();
+  assert(window.value() == "bc");
+  window.push("d");
+  assert(window.value() == "bcd");
+  window.pop();
+  window.pop();
+  assert(window.value() == "d");
+}
+
+auto test_mask() -> void {
+  using Prelude::mask;
+  auto even = [](int x) { return x % 2 == 0; };
+  auto xs = std::vector<int>{};
+  for (auto i = 0; i < 130; ++i) {
+    xs.push_back(i);
+  }
+  auto m = mask(even, xs);
+  assert(m.size() == 130);
+  for (std::size_t i = 0; i < xs.size(); ++i) {
+    assert(m[i] == even(xs[i]));
+  }
+  auto n = ~m;
+  assert(!n[0] && n[129]);
+  assert((m & n) == mask([](int) { return false; }, xs));
+  assert((m | n) == mask([](int) { return true; }, xs));
+}
+
+auto test_mask_folds() -> void {
+  using Prelude::and_;
+  using Prelude::count;
+  using Prelude::mask;
+  using Prelude::or_;
+  auto xs = std::vector<int>(100, 1);
+  auto one = [](int x) { return x == 1; };
+  auto two = [](int x) { return x == 2; };
+  assert(and_(mask(one, xs)) == true);
+  assert(or_(mask(two, xs)) == false);
+  xs[70] = 2;
+  assert(and_(mask(one, xs)) == false);
+  assert(or_(mask(two, xs)) == true);
+  assert(count(mask(one, xs)) == 99);
+  assert(count(mask(two, xs)) == 1);
+  assert(and_(mask(one, std::vector<int>{})) == true);
+}
+
+auto test_filterByMask() -> void {
+  using Prelude::filterByMask;
+  using Prelude::mask;
+  auto even = [](int x) { return x % 2 == 0; };
+  auto expect = std::vector<int>{2, 4};
+  auto xs = std::vector<int>{1, 2, 3, 4, 5};
+  assert(filterByMask(mask(even, xs), xs) == expect);
+  auto ls = std::list<std::string>{"a", "bb", "c", "dd"};
+  auto expectL = std::list<std::string>{"bb", "dd"};
+  auto m = mask([](const std::string& s) { return s.size() == 2; }, ls);
+  assert(filterByMask(m, ls) == expectL);
+  auto fs = std::forward_list<int>{1, 2, 3, 4, 5};
+  auto expectF = std::forward_list<int>{2, 4};
+  assert(filterByMask(mask(even, fs), fs) == expectF);
+}
+
+auto test_compress() -> void {
+  using Prelude::compress;
+  using Prelude::filter;
+  auto pred = [](int x) { return x % 3 == 0; };
+  auto xs = std::vector<int>{};
+  for (auto i = 0; i < 200; ++i) {
+    xs.push_back(i * 7 % 11);
+  }
+  assert(compress(pred, xs) == filter(pred, xs));
+  auto sparse = compress([](int x) { return x == 0; }, xs);
+  assert(sparse.capacity() == sparse.size());
+  auto expectS = std::string{"GETHEAD"};
+  auto resultS = compress([](char x) { return x >= 'A' && x <= 'Z'; },
+                          std::string{"GET /a HEAD /b"});
+  assert(resultS == expectS);
+}
+
+auto test_memoize() -> void {
+  using Prelude::map;
+  using Prelude::memoize;
+  auto calls = 0;
+  auto square = memoize<int>([&calls](int x) {
+    ++calls;
+    return x * x;
+  }, 8);
+  auto expect = std::vector<int>{1, 4, 1, 4, 1, 4};
+  auto result = map(square, std::vector<int>{1, 2, 1, 2, 1, 2});
+  assert(result == expect);
+  assert(calls == 2);
+  assert(square.hits() == 4);
+  assert(square.misses() == 2);
+  assert(square.hitRate() > 0.6 && square.hitRate() < 0.7);
+}
+
+auto test_memoize_eviction() -> void {
+  using Prelude::ClockCache;
+  using Prelude::memoize;
+  auto calls = 0;
+  auto f = [&calls](int x) {
+    ++calls;
+    return x;
+  };
+  // LRU: touching 1 makes 2 the victim
+  auto lru = memoize<int>(f, 2, 1);
+  lru(1);
+  lru(2);
+  lru(1);
+  lru(3);
+  calls = 0;
+  lru(1);
+  assert(calls == 0);
+  lru(2);
+  assert(calls == 1);
+  // CLOCK: 1 gets a second chance, 2 is evicted
+  auto clock = memoize<int, ClockCache>(f, 2, 1);
+  clock(1);
+  clock(2);
+  clock(1);
+  clock(3);
+  calls = 0;
+  clock(1);
+  assert(calls == 0);
+  clock(2);
+  assert(calls == 1);
+}
+
+auto test_memoize_capacity() -> void {
+  using Prelude::ClockCache;
+  using Prelude::memoize;
+  auto f = [](int x) { return x; };
+  // at most 4 entries even with the default 16 shards
+  auto lru = memoize<int>(f, 4);
+  auto clock = memoize<int, ClockCache>(f, 4);
+  for (auto pass = 0; pass < 2; ++pass) {
+    for (auto x = 0; x < 16; ++x) {
+      lru(x);
+      clock(x);
+    }
+  }
+  assert(lru.misses() == 32 && lru.hits() == 0);
+  assert(clock.misses() == 32 && clock.hits() == 0);
+  // shards of 4, 3 and 3 entries; std::hash<int> is the identity in
+  // libstdc++ and libc++, so every shard sees ten keys
+  auto split = memoize<int>(f, 10, 3);
+  for (auto pass = 0; pass < 2; ++pass) {
+    for (auto x = 0; x < 30; ++x) {
+      split(x);
+    }
+  }
+  assert(split.hits() == 0);
+  // the newest 4 + 3 + 3 keys are cached, 19 and 20 were evicted
+  for (auto x = 29; x >= 18; --x) {
+    split(x);
+  }
+  assert(split.hits() == 10);
+  auto thrown = false;
+  try {
+    memoize<int>(f, 0);
+  } catch (const std::invalid_argument&) {
+    thrown = true;
+  }
+  assert(thrown);
+}
+
+auto test_memoize_threads() -> void {
+  using Prelude::map;
+  using Prelude::memoize;
+  auto square = memoize<int>([](int x) { return x * x; }, 64, 4);
+  auto xs = std::vector<int>{};
+  for (auto i = 0; i < 1000; ++i) {
+    xs.push_back(i % 10);
+  }
+  auto threads = std::vector<std::thread>{};
+  for (auto t = 0; t < 4; ++t) {
+    threads.emplace_back([&] {
+      auto result = map(square, xs);
+      for (std::size_t i = 0; i < xs.size(); ++i) {
+        assert(result[i] == xs[i] * xs[i]);
+      }
+    });
+  }
+  for (auto& t : threads) {
+    t.join();
+  }
+  assert(square.hits() + square.misses() == 4000);
+  assert(square.misses() >= 10 && square.misses() <= 40);
+}
+
 auto test_take() -> void {
   using Prelude::take;
   auto expect = std::vector<int>{1, 2, 3, 4};
@@ -203,6 +790,10 @@ auto test_take() -> void {
   // also check case for n > size
   result = take(100, expect);
   assert(result == expect && "Also has to work for n > size!");
+  assert(take(2, std::list<int>{1, 2, 3}) == (std::list<int>{1, 2}));
+  assert(take(5, std::forward_list<int>{1, 2, 3}) ==
+         (std::forward_list<int>{1, 2, 3}));
+  assert(take(2, std::string{"abc"}) == "ab");
 }
 
 auto test_drop() -> void {
@@ -214,6 +805,10 @@ auto test_drop() -> void {
   result = drop(100, std::vector<int>{1, 2, 3, 4});
   expect = std::vector<int>{};
   assert(result == expect && "Also has to work for n > size!");
+  assert(drop(2, std::list<int>{1, 2, 3}) == (std::list<int>{3}));
+  assert(drop(1, std::forward_list<int>{1, 2, 3}) ==
+         (std::forward_list<int>{2, 3}));
+  assert(drop(5, std::string{"abc"}) == "");
 }
 
 auto test_splitAt() -> void {
@@ -285,6 +880,9 @@ auto test_zip() -> void {
   auto result =
       zip(std::vector<int>{1, 2, 3}, std::list<bool>{true, false, true});
   assert(result == expect);
+  result = zip(std::vector<int>{1, 2, 3, 4},
+               std::forward_list<bool>{true, false, true});
+  assert(result == expect);
 }
 
 auto test_zip3() -> void {
@@ -328,6 +926,10 @@ auto test_unzip() -> void {
       std::make_tuple(3, true)});
   assert(resultL == expectL);
   assert(resultR == expectR);
+  auto expectF = std::forward_list<int>{1, 2};
+  auto resultF = std::get<0>(unzip(std::forward_list<std::tuple<int, char>>{
+      std::make_tuple(1, 'a'), std::make_tuple(2, 'b')}));
+  assert(resultF == expectF);
 }
 
 auto test_unzip3() -> void {
@@ -347,6 +949,102 @@ auto test_unzip3() -> void {
   assert(resultR == expectR);
 }
 
+auto test_zipN() -> void {
+  using Prelude::zipN;
+  auto expect = std::vector<std::tuple<int, bool, char, double>>{
+      std::make_tuple(1, true, 'a', 0.5), std::make_tuple(2, false, 'b', 1.5)};
+  auto result = zipN(std::vector<int>{1, 2, 3}, std::list<bool>{true, false},
+                     std::vector<char>{'a', 'b', 'c'},
+                     std::vector<double>{0.5, 1.5, 2.5, 3.5});
+  assert(result == expect);
+}
+
+auto test_zipWithN() -> void {
+  using Prelude::zipWithN;
+  auto expect = std::vector<double>{15, 30, 45};
+  auto result = zipWithN(
+      [](int a, double b, long c, float d, int e) { return a + b + c + d + e; },
+      std::vector<int>{1, 2, 3}, std::vector<double>{2, 4, 6, 8},
+      std::vector<long>{3, 6, 9}, std::vector<float>{4, 8, 12},
+      std::vector<int>{5, 10, 15, 20, 25});
+  assert(result == expect);
+  auto expectL = std::list<int>{2, 4};
+  auto resultL = zipWithN([](int x, int y) { return x * y; },
+                          std::list<int>{1, 2}, std::vector<int>{2, 2, 2});
+  assert(resultL == expectL);
+}
+
+auto test_unzipN() -> void {
+  using Prelude::unzipN;
+  auto expectA = std::vector<int>{1, 2};
+  auto expectB = std::vector<bool>{true, false};
+  auto expectC = std::vector<char>{'a', 'b'};
+  auto expectD = std::vector<std::string>{"x", "y"};
+  auto result = unzipN(std::vector<std::tuple<int, bool, char, std::string>>{
+      std::make_tuple(1, true, 'a', "x"), std::make_tuple(2, false, 'b', "y")});
+  assert(std::get<0>(result) == expectA);
+  assert(std::get<1>(result) == expectB);
+  assert(std::get<2>(result) == expectC);
+  assert(std::get<3>(result) == expectD);
+}
+
+auto test_lines() -> void {
+  using Prelude::StringSlice;
+  using Prelude::lines;
+  auto text = std::string{"first line\n\nthird line\nlast"};
+  auto expect =
+      std::vector<StringSlice>{"first line", "", "third line", "last"};
+  auto result = lines(text);
+  assert(result == expect);
+  assert(result[0].data() == text.data());
+  assert(lines(std::string{"a\n"}.c_str()).size() == 1);
+  assert(lines("").empty());
+}
+
+auto test_words() -> void {
+  using Prelude::StringSlice;
+  using Prelude::filter;
+  using Prelude::foldl;
+  using Prelude::length;
+  using Prelude::map;
+  using Prelude::words;
+  auto text = std::string{"  GET /index.html\t200 \n 0.042s\r\n"};
+  auto expect = std::vector<StringSlice>{"GET", "/index.html", "200", "0.042s"};
+  auto result = words(text);
+  assert(result == expect);
+  assert(words(std::string(100, ' ').c_str()).empty());
+  auto longWord = std::string(50, 'x') + " " + std::string(20, 'y');
+  assert(length(words(longWord)) == 2);
+  assert(words(longWord)[0].size() == 50);
+  // slices work with the rest of the Prelude
+  auto sizes = map([](StringSlice w) { return w.size(); }, result);
+  assert(foldl([](std::size_t acc, std::size_t x) { return acc + x; },
+               std::size_t{0}, sizes) == 23);
+  auto shortWords =
+      filter([](StringSlice w) { return w.size() <= 3; }, result);
+  assert(length(shortWords) == 2);
+}
+
+auto test_unlines() -> void {
+  using Prelude::lines;
+  using Prelude::unlines;
+  auto expect = std::string{"a\n\nbc\n"};
+  auto result = unlines(std::vector<std::string>{"a", "", "bc"});
+  assert(result == expect);
+  assert(unlines(lines(expect)) == expect);
+  assert(unlines(std::vector<std::string>{}) == "");
+}
+
+auto test_unwords() -> void {
+  using Prelude::unwords;
+  using Prelude::words;
+  auto expect = std::string{"a bc d"};
+  auto result = unwords(std::vector<std::string>{"a", "bc", "d"});
+  assert(result == expect);
+  assert(unwords(words("  a \t bc\nd ")) == expect);
+  assert(unwords(std::list<std::string>{}) == "");
+}
+
 int main() {
   test_not_();
   // List operations
@@ -365,6 +1063,14 @@ int main() {
   test_foldl1();
   test_foldr();
   test_foldr1();
+  // Short-circuiting folds
+  test_Maybe();
+  test_foldlWhile();
+  test_foldlUntil();
+  test_foldM();
+  test_parFoldM();
+  test_parFoldM_accumulator();
+  test_parFoldM_cancel();
   // Special folds
   test_and_();
   test_or_();
@@ -372,10 +1078,29 @@ int main() {
   test_all();
   test_sum();
   test_product();
+  test_sumPairwise();
+  test_sumKahan();
+  test_parSum();
   test_concat();
   test_concatMap();
   test_maximum();
   test_minimum();
+  // Incremental folds and windows
+  test_runningFold();
+  test_SlidingSum();
+  test_SlidingProduct();
+  test_SlidingMaximum();
+  test_slidingFold();
+  // Bit masks
+  test_mask();
+  test_mask_folds();
+  test_filterByMask();
+  test_compress();
+  // Memoization
+  test_memoize();
+  test_memoize_eviction();
+  test_memoize_capacity();
+  test_memoize_threads();
   // Sublists
   test_take();
   test_drop();
@@ -391,6 +1116,14 @@ int main() {
   test_zipWith3();
   test_unzip();
   test_unzip3();
+  test_zipN();
+  test_zipWithN();
+  test_unzipN();
+  // Functions on strings
+  test_lines();
+  test_words();
+  test_unlines();
+  test_unwords();
 
   std::cout << "Looking good!\n";
 }